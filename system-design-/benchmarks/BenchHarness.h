@@ -0,0 +1,331 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// Micro-benchmark harness shared by the *Bench.CPP drivers in this folder.
+// Every driver is a program of its own: it includes this header, then one
+// module with the module's demo main renamed, and is built on its own, e.g.
+//
+//   g++ -std=c++17 -O2 -pthread benchmarks/DarkStoreBench.CPP -o dark_store_bench
+//   ./dark_store_bench --max-scale 100000 --baseline bench_results.jsonl
+//
+// Flags: --max-scale N  largest entity count (scales go 10^3, 10^4, ...)
+//        --ops N        timed operations per measurement
+//        --seed N       workload seed; same seed, same workload
+//        --out FILE     results are appended here as JSON lines
+//        --baseline F   earlier results file; slower or allocation-heavier
+//                       runs are reported and the exit code becomes 1
+//        --tolerance X  allowed p50 slowdown before it counts (default 0.25)
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <ctime>
+#include <new>
+using namespace std;
+
+// Counting allocator hook: the global new/delete below replace the default
+// ones for the whole process, so include this header from exactly one
+// translation unit. Counts are process wide; a module's own worker threads
+// allocating during a measurement are charged to it.
+class AllocationCounter {
+public:
+    static atomic<long long> allocations;
+    static atomic<long long> bytes;
+};
+
+atomic<long long> AllocationCounter::allocations(0);
+atomic<long long> AllocationCounter::bytes(0);
+
+void* operator new(size_t size) {
+    AllocationCounter::allocations.fetch_add(1, memory_order_relaxed);
+    AllocationCounter::bytes.fetch_add((long long)size, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+// GCC inlines this into callers and then mistakes the free() for a
+// mismatched delete of the new'd pointer
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+// Mutes cout while alive; most modules print on their hot paths
+class QuietScope {
+private:
+    streambuf* original;
+
+public:
+    QuietScope() {
+        original = cout.rdbuf(nullptr);
+    }
+
+    ~QuietScope() {
+        cout.rdbuf(original);
+    }
+};
+
+class BenchConfig {
+public:
+    long maxScale;
+    long ops;
+    unsigned seed;
+    string outPath;
+    string baselinePath;
+    double tolerance;
+
+    BenchConfig(int argc, char** argv, long defaultMaxScale, long defaultOps) {
+        maxScale = defaultMaxScale;
+        ops = defaultOps;
+        seed = 42;
+        outPath = "bench_results.jsonl";
+        tolerance = 0.25;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            string value = argv[i + 1];
+            if (flag == "--max-scale") {
+                maxScale = atol(value.c_str());
+            } else if (flag == "--ops") {
+                ops = atol(value.c_str());
+            } else if (flag == "--seed") {
+                seed = (unsigned)atol(value.c_str());
+            } else if (flag == "--out") {
+                outPath = value;
+            } else if (flag == "--baseline") {
+                baselinePath = value;
+            } else if (flag == "--tolerance") {
+                tolerance = atof(value.c_str());
+            } else {
+                cerr << "Unknown flag " << flag << endl;
+            }
+        }
+    }
+
+    // 10^3, 10^4, ... up to maxScale
+    vector<long> scales() const {
+        vector<long> result;
+        for (long scale = 1000; scale <= maxScale; scale *= 10) {
+            result.push_back(scale);
+        }
+        return result;
+    }
+};
+
+class BenchResult {
+public:
+    string module;
+    string variant;
+    long scale;
+    long ops;
+    double opsPerSec;
+    double p50Ns;
+    double p99Ns;
+    double allocsPerOp;
+    double bytesPerOp;
+
+    string toJson(long long timestamp) const {
+        ostringstream out;
+        out << "{\"module\":\"" << module << "\",\"variant\":\"" << variant << "\",\"scale\":" << scale
+            << ",\"ops\":" << ops << ",\"ops_per_sec\":" << opsPerSec << ",\"p50_ns\":" << p50Ns
+            << ",\"p99_ns\":" << p99Ns << ",\"allocs_per_op\":" << allocsPerOp
+            << ",\"bytes_per_op\":" << bytesPerOp << ",\"timestamp\":" << timestamp << "}";
+        return out.str();
+    }
+
+    // Reads back a line written by toJson (flat objects only)
+    static bool fromJson(const string& line, BenchResult& result) {
+        string scale = field(line, "scale");
+        if (scale.empty()) {
+            return false;
+        }
+        result.module = field(line, "module");
+        result.variant = field(line, "variant");
+        result.scale = atol(scale.c_str());
+        result.ops = atol(field(line, "ops").c_str());
+        result.opsPerSec = atof(field(line, "ops_per_sec").c_str());
+        result.p50Ns = atof(field(line, "p50_ns").c_str());
+        result.p99Ns = atof(field(line, "p99_ns").c_str());
+        result.allocsPerOp = atof(field(line, "allocs_per_op").c_str());
+        result.bytesPerOp = atof(field(line, "bytes_per_op").c_str());
+        return true;
+    }
+
+    string key() const {
+        return module + "/" + variant + "/" + to_string(scale);
+    }
+
+private:
+    static string field(const string& line, const string& name) {
+        string tag = "\"" + name + "\":";
+        size_t pos = line.find(tag);
+        if (pos == string::npos) {
+            return "";
+        }
+        pos += tag.size();
+        size_t end = line.find_first_of(",}", pos);
+        string value = line.substr(pos, end == string::npos ? string::npos : end - pos);
+        if (!value.empty() && value[0] == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+        return value;
+    }
+};
+
+// Runs the timed loops and owns the results of one driver run
+class BenchRunner {
+private:
+    string module;
+    const BenchConfig& config;
+    vector<BenchResult> results;
+    vector<long long> samples;
+
+    static double percentile(vector<long long>& sorted, double q) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t index = (size_t)(q * (sorted.size() - 1) + 0.5);
+        return (double)sorted[index];
+    }
+
+public:
+    BenchRunner(const string& module, const BenchConfig& config) : config(config) {
+        this->module = module;
+        cout << "module           variant                  scale      ops      ops/s     p50 ns     p99 ns  allocs/op   bytes/op" << endl;
+    }
+
+    // prepare(i) runs untimed before each op(i); only op(i) is timed and
+    // only its allocations are counted
+    template <typename Prepare, typename Op>
+    void measure(const string& variant, long scale, long ops, Prepare prepare, Op op) {
+        samples.assign(max(1L, ops), 0);
+        long long allocations = 0;
+        long long bytes = 0;
+        long long totalNs = 0;
+        {
+            QuietScope quiet;
+            for (long i = 0; i < ops; i++) {
+                prepare(i);
+                long long allocsBefore = AllocationCounter::allocations.load(memory_order_relaxed);
+                long long bytesBefore = AllocationCounter::bytes.load(memory_order_relaxed);
+                auto start = chrono::steady_clock::now();
+                op(i);
+                auto end = chrono::steady_clock::now();
+                allocations += AllocationCounter::allocations.load(memory_order_relaxed) - allocsBefore;
+                bytes += AllocationCounter::bytes.load(memory_order_relaxed) - bytesBefore;
+                long long ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+                samples[i] = ns;
+                totalNs += ns;
+            }
+        }
+        sort(samples.begin(), samples.begin() + max(1L, ops));
+
+        BenchResult result;
+        result.module = module;
+        result.variant = variant;
+        result.scale = scale;
+        result.ops = ops;
+        result.opsPerSec = totalNs > 0 ? ops * 1e9 / totalNs : 0;
+        result.p50Ns = percentile(samples, 0.50);
+        result.p99Ns = percentile(samples, 0.99);
+        result.allocsPerOp = ops > 0 ? (double)allocations / ops : 0;
+        result.bytesPerOp = ops > 0 ? (double)bytes / ops : 0;
+        results.push_back(result);
+
+        char line[256];
+        snprintf(line, sizeof(line), "%-16s %-20s %9ld %8ld %10.0f %10.0f %10.0f %10.2f %10.1f",
+                 module.c_str(), variant.c_str(), scale, ops, result.opsPerSec,
+                 result.p50Ns, result.p99Ns, result.allocsPerOp, result.bytesPerOp);
+        cout << line << endl;
+    }
+
+    template <typename Op>
+    void measure(const string& variant, long scale, long ops, Op op) {
+        measure(variant, scale, ops, [](long) {}, op);
+    }
+
+    // Compares the results with the latest matching entries of the baseline
+    // file, then appends them to the output file. Returns the exit code.
+    int finish() {
+        // Read the baseline first: it is usually the same file as --out
+        map<string, BenchResult> baseline;
+        if (!config.baselinePath.empty()) {
+            ifstream in(config.baselinePath);
+            string line;
+            while (getline(in, line)) {
+                BenchResult entry;
+                if (BenchResult::fromJson(line, entry)) {
+                    baseline[entry.key()] = entry;   // later runs win
+                }
+            }
+        }
+
+        long long timestamp = (long long)time(nullptr);
+        ofstream out(config.outPath, ios::app);
+        for (const BenchResult& result : results) {
+            out << result.toJson(timestamp) << "\n";
+        }
+        out.close();
+        if (out.fail()) {
+            cerr << "Unable to write results to " << config.outPath << endl;
+        } else {
+            cout << "Results appended to " << config.outPath << endl;
+        }
+
+        if (config.baselinePath.empty()) {
+            return 0;
+        }
+        int regressions = 0;
+        for (const BenchResult& result : results) {
+            auto it = baseline.find(result.key());
+            if (it == baseline.end()) {
+                continue;
+            }
+            const BenchResult& base = it->second;
+            bool slower = result.p50Ns > base.p50Ns * (1 + config.tolerance);
+            bool heavier = result.allocsPerOp > base.allocsPerOp + 0.5;
+            if (slower || heavier) {
+                regressions++;
+                cout << "REGRESSION " << result.key() << ": p50 " << base.p50Ns << " -> " << result.p50Ns
+                     << " ns, allocs/op " << base.allocsPerOp << " -> " << result.allocsPerOp << endl;
+            }
+        }
+        cout << (regressions ? to_string(regressions) + " regression(s) against " : "No regressions against ")
+             << config.baselinePath << endl;
+        return regressions ? 1 : 0;
+    }
+};
+
+#endif // BENCH_HARNESS_H
\ No newline at end of file